@@ -0,0 +1,66 @@
+#include "active_notes.h"
+
+/**
+ * Constructor to start with no notes sounding
+ *
+ * @return void
+ */
+ActiveNotes::ActiveNotes() {
+  for(int i = 0; i < NUM_MIDI_NOTES / 8; i++) {
+    this->notes[i] = 0;
+  }
+}
+
+/**
+ * Mark a note as sounding. Notes outside the MIDI range are ignored
+ *
+ * @params int note The MIDI note number
+ *
+ * @return void
+ */
+void ActiveNotes::set(int note) {
+  if(note >= 0 && note < NUM_MIDI_NOTES) {
+    this->notes[note >> 3] |= (1 << (note & 7));
+  }
+}
+
+/**
+ * Mark a note as no longer sounding. Notes outside the MIDI range are ignored
+ *
+ * @params int note The MIDI note number
+ *
+ * @return void
+ */
+void ActiveNotes::clear(int note) {
+  if(note >= 0 && note < NUM_MIDI_NOTES) {
+    this->notes[note >> 3] &= ~(1 << (note & 7));
+  }
+}
+
+/**
+ * Is a note sounding
+ *
+ * @params int note The MIDI note number
+ *
+ * @return bool Is the note sounding (false for notes outside the MIDI range)
+ */
+bool ActiveNotes::isActive(int note) {
+  if(note < 0 || note >= NUM_MIDI_NOTES) {
+    return false;
+  }
+  return (this->notes[note >> 3] >> (note & 7)) & 1;
+}
+
+/**
+ * Are no notes sounding
+ *
+ * @return bool
+ */
+bool ActiveNotes::isEmpty() {
+  for(int i = 0; i < NUM_MIDI_NOTES / 8; i++) {
+    if(this->notes[i] != 0) {
+      return false;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,32 @@
+/**
+ * Bitset of the MIDI notes sounding on the instrument's channel. Tracks exactly which note on messages have been
+ * sent without a matching note off so state changes can release only those notes. Every sounding note is released
+ * before the instrument changes channel, so only the current channel ever needs tracking
+ */
+
+#ifndef ACTIVE_NOTES_H   /* Include guard */
+#define ACTIVE_NOTES_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "midi_consts.h"
+
+class ActiveNotes {
+  public:
+    // Constructor: Start with no notes sounding
+    ActiveNotes();
+    // Mark a note as sounding
+    void set(int note);
+    // Mark a note as no longer sounding
+    void clear(int note);
+    // Is a note sounding
+    bool isActive(int note);
+    // Are no notes sounding
+    bool isEmpty();
+
+  private:
+    uint8_t notes[NUM_MIDI_NOTES / 8]; // One bit per MIDI note
+};
+
+#endif // ACTIVE_NOTES_H
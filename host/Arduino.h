@@ -0,0 +1,68 @@
+/**
+ * Minimal stand-in for the Arduino core so the instrument's classes can be built and measured on a host machine.
+ * Registers are plain variables, interrupts are ordinary functions the harness calls, and the clock and serial
+ * port are driven and recorded by the harness
+ */
+
+#ifndef ARDUINO_H   /* Include guard */
+#define ARDUINO_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define SERIAL_8N1 0
+#define _BV(bit) (1 << (bit))
+
+const int NUM_HOST_PINS = 64;
+
+// Registers written by the sketch's classes
+extern volatile uint8_t SREG, PCICR, PCMSK, TCCR2A, TCCR2B, TCNT2, OCR2A, TIMSK2;
+const int WGM21 = 1;
+const int CS22 = 2;
+const int OCIE2A = 1;
+
+// Each pin gets its own input register so the harness can drive every key independently
+extern volatile uint8_t hostPinRegisters[NUM_HOST_PINS];
+#define digitalPinToPort(pin) (pin)
+#define portInputRegister(port) (&hostPinRegisters[port])
+#define digitalPinToBitMask(pin) ((uint8_t)1)
+// Pins 10 - 15 have pin change interrupts, as on the Mega
+#define digitalPinToPCICR(pin) ((pin) >= 10 && (pin) <= 15 ? &PCICR : (volatile uint8_t *)NULL)
+#define digitalPinToPCICRbit(pin) 0
+#define digitalPinToPCMSK(pin) (&PCMSK)
+#define digitalPinToPCMSKbit(pin) 0
+
+// Interrupt handlers become functions the harness calls directly
+#define ISR(vector) void vector()
+#define PCINT0_vect hostPinChangeInterrupt
+#define TIMER2_COMPA_vect hostTimer2Interrupt
+void hostPinChangeInterrupt();
+void hostTimer2Interrupt();
+inline void cli() {}
+inline void sei() {}
+
+// Clock driven by the harness
+extern unsigned long hostMicros;
+inline unsigned long micros() { return hostMicros; }
+inline unsigned long millis() { return hostMicros / 1000; }
+
+int digitalRead(int pin);
+int analogRead(int pin);
+void pinMode(int pin, int mode);
+
+// Serial port which records the bytes written instead of sending them
+class HostSerial {
+  public:
+    void begin(unsigned long baud, int config);
+    size_t write(uint8_t value);
+    unsigned long byteCount; // Number of bytes written
+    uint8_t lastBytes[256]; // The most recent bytes written
+};
+extern HostSerial Serial;
+
+#endif // ARDUINO_H
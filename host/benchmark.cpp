@@ -0,0 +1,452 @@
+/**
+ * Host benchmark for the instrument's MIDI pipeline
+ *
+ * Builds the sketch's classes against the stubbed Arduino core and drives them through fixed workloads, reporting
+ * the MIDI events and bytes each workload produces and the time each pipeline stage spends per MIDI event
+ */
+
+#include <stdio.h>
+#include <chrono>
+#include "Arduino.h"
+#include "instrument.h"
+#include "midi_event_queue.h"
+#include "midi_transmitter.h"
+#include "key_capture.h"
+
+const int KEY_PRESS_ROUNDS = 200000;
+const int BOUNCE_KEY_PIN = 10; // A key with a pin change interrupt, so every bounce edge reaches the capture
+const int BOUNCE_EDGES = 7; // Contact edges per press or release, ending on the new value
+const unsigned long BOUNCE_EDGE_MICROS = 100; // Time between contact edges
+const int MAX_LOGGED_NOTE_ONS = 16; // Note ons whose ticks are printed per phase of a scheduler workload
+const unsigned long STALL_MILLIS = 600; // Time the main loop is stalled for while a key is held
+const double MIDI_BYTE_MICROS = 10 * 1000000.0 / 57600; // 8N1 at the sketch's baud rate
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * The pipeline as it is wired up by the sketch, with the control pin values the sketch would read
+ */
+struct Pipeline {
+  Pin pins[NUM_PINS_USED];
+  int controlValues[FIRST_NOTE_PIN];
+  KeyEventQueue keyEvents;
+  MidiEventQueue midiEvents;
+  MidiTransmitter transmitter;
+  Instrument * instrument;
+  double instrumentNanos; // Time spent in Instrument::play()
+  double transmitterNanos; // Time spent in MidiTransmitter::transmit()
+
+  Pipeline() {
+    for(int i = 0; i < FIRST_NOTE_PIN; i++) {
+      this->controlValues[i] = LOW;
+    }
+    this->instrument = new Instrument(this->pins, &this->midiEvents);
+    this->instrumentNanos = 0;
+    this->transmitterNanos = 0;
+    Serial.begin(57600, SERIAL_8N1);
+  }
+
+  ~Pipeline() {
+    delete this->instrument;
+  }
+
+  /**
+   * Run one pass of the sketch's loop(), timing the instrument and transmitter stages separately
+   *
+   * @return void
+   */
+  void loop() {
+    for(int i = 0; i < FIRST_NOTE_PIN; i++) {
+      this->pins[i].setValue(this->controlValues[i]);
+    }
+
+    bool isPlayed = false;
+    while(!isPlayed) {
+      Clock::time_point start = Clock::now();
+      isPlayed = this->instrument->play(&this->keyEvents);
+      Clock::time_point played = Clock::now();
+      this->transmitter.transmit(&this->midiEvents);
+      Clock::time_point transmitted = Clock::now();
+      this->instrumentNanos += std::chrono::duration<double, std::nano>(played - start).count();
+      this->transmitterNanos += std::chrono::duration<double, std::nano>(transmitted - played).count();
+    }
+  }
+
+  /**
+   * Press and release a control button over two passes of the loop
+   *
+   * @params int pinIndex The index of the control pin
+   *
+   * @return void
+   */
+  void click(int pinIndex) {
+    this->controlValues[pinIndex] = HIGH;
+    this->loop();
+    this->controlValues[pinIndex] = LOW;
+    this->loop();
+  }
+};
+
+/**
+ * Press and release every key in turn, measuring the per MIDI event cost of each pipeline stage
+ *
+ * @return void
+ */
+void benchmarkKeyPresses() {
+  Pipeline pipeline;
+  for(int i = 0; i < KEY_PRESS_ROUNDS; i++) {
+    uint8_t pinIndex = FIRST_NOTE_PIN + i % NUM_NOTE_PINS;
+    pipeline.keyEvents.push(pinIndex, HIGH, hostMicros);
+    pipeline.loop();
+    pipeline.keyEvents.push(pinIndex, LOW, hostMicros);
+    pipeline.loop();
+  }
+
+  double events = KEY_PRESS_ROUNDS * 2.0;
+  printf("key presses: %.0f MIDI events, %lu bytes\n", events, Serial.byteCount);
+  printf("  instrument  %6.1f ns/event\n", pipeline.instrumentNanos / events);
+  printf("  transmitter %6.1f ns/event\n", pipeline.transmitterNanos / events);
+  printf("  wire        %6.1f us/event at 57600 baud\n", Serial.byteCount / events * MIDI_BYTE_MICROS);
+}
+
+/**
+ * Run a workload of state changes and key presses, comparing the bytes sent against a channel wide all notes off
+ * on every state change and a note off on every key release, which is what the instrument sent before it tracked
+ * the sounding notes
+ *
+ * @params const char * name           The name of the workload
+ * @params int          rounds         The number of times to repeat the workload
+ * @params int          heldKeys       The number of keys pressed before the state changes
+ * @params const int *  controlPins    The control buttons clicked while the keys are held
+ * @params int          numControlPins The number of control buttons clicked
+ *
+ * @return void
+ */
+void benchmarkStateChanges(const char * name, int rounds, int heldKeys, const int * controlPins, int numControlPins) {
+  Pipeline pipeline;
+  unsigned long blindBytes = 0;
+  for(int i = 0; i < rounds; i++) {
+    for(int key = 0; key < heldKeys; key++) {
+      pipeline.keyEvents.push(FIRST_NOTE_PIN + key, HIGH, hostMicros);
+    }
+    pipeline.loop();
+    for(int j = 0; j < numControlPins; j++) {
+      pipeline.click(controlPins[j]);
+    }
+    for(int key = 0; key < heldKeys; key++) {
+      pipeline.keyEvents.push(FIRST_NOTE_PIN + key, LOW, hostMicros);
+    }
+    pipeline.loop();
+    blindBytes += 3 * (heldKeys * 2 + numControlPins);
+  }
+
+  printf("%s: %lu bytes, %lu bytes with blind all notes off\n", name, Serial.byteCount, blindBytes);
+}
+
+/**
+ * Step the host clock forward, running the 1 kHz scan timer interrupt at every millisecond it passes
+ *
+ * @params unsigned long micros The number of microseconds to step forward
+ *
+ * @return void
+ */
+void runClock(unsigned long micros) {
+  for(unsigned long end = hostMicros + micros; hostMicros < end; hostMicros++) {
+    if(hostMicros % 1000 == 0) {
+      hostTimer2Interrupt();
+    }
+  }
+}
+
+/**
+ * Bounce a key's contacts, running its pin change interrupt on every edge
+ *
+ * @params uint8_t value The value the key settles on
+ *
+ * @return void
+ */
+void bounceKey(uint8_t value) {
+  for(int edge = BOUNCE_EDGES - 1; edge >= 0; edge--) {
+    hostPinRegisters[BOUNCE_KEY_PIN] = edge % 2 == 0 ? value : !value;
+    hostPinChangeInterrupt();
+    runClock(BOUNCE_EDGE_MICROS);
+  }
+}
+
+/**
+ * Press and release a key whose contacts bounce, counting the key events captured and the MIDI bytes sent
+ *
+ * @return void
+ */
+void benchmarkKeyBounce() {
+  Pipeline pipeline;
+  KeyCapture keyCapture;
+  int keyEventCount = 0;
+  KeyEvent keyEvents[KEY_EVENT_QUEUE_SIZE];
+
+  keyCapture.begin(pipeline.pins, &pipeline.keyEvents);
+  for(int i = 0; i < 2; i++) {
+    bounceKey(i == 0 ? HIGH : LOW);
+    runClock(KEY_DEBOUNCE_MICROS * 2);
+    // Count the captured events, then hand them back for the loop to play
+    int numKeyEvents = 0;
+    while(pipeline.keyEvents.pop(&keyEvents[numKeyEvents])) {
+      numKeyEvents++;
+    }
+    for(int j = 0; j < numKeyEvents; j++) {
+      pipeline.keyEvents.push(keyEvents[j].pinIndex, keyEvents[j].value, keyEvents[j].timestamp);
+    }
+    keyEventCount += numKeyEvents;
+    pipeline.loop();
+  }
+
+  printf("bouncing key press and release: %d contact edges, %d key events, %lu bytes\n", 
+    BOUNCE_EDGES * 2, keyEventCount, Serial.byteCount);
+}
+
+/**
+ * Press every key while the main loop is stalled for a second, so more transitions arrive than the key event queue 
+ * holds, then let the loop catch up and release the keys
+ *
+ * @return void
+ */
+void benchmarkStalledLoop() {
+  Pipeline pipeline;
+  KeyCapture keyCapture;
+
+  keyCapture.begin(pipeline.pins, &pipeline.keyEvents);
+  for(int i = 0; i < NUM_NOTE_PINS; i++) {
+    hostPinRegisters[FIRST_NOTE_PIN + i] = HIGH;
+  }
+  runClock(1000000);
+  pipeline.loop();
+  runClock(KEY_DEBOUNCE_MICROS * 2);
+  pipeline.loop();
+  for(int i = 0; i < NUM_NOTE_PINS; i++) {
+    hostPinRegisters[FIRST_NOTE_PIN + i] = LOW;
+  }
+  runClock(KEY_DEBOUNCE_MICROS * 2);
+  pipeline.loop();
+  runClock(KEY_DEBOUNCE_MICROS * 2);
+  pipeline.loop();
+
+  printf("%d keys pressed during a 1 s stall, then released: %u dropped key transitions, %lu bytes\n", 
+    NUM_NOTE_PINS, keyCapture.getDroppedCount(), Serial.byteCount);
+}
+
+/**
+ * Hold every key through an octave shift with held keys struck again at their new pitch. Releasing all 36 sounding 
+ * notes and striking all 36 held keys again do not fit the MIDI event queue as one action, so this checks the strike 
+ * is queued as its own action and every note is still sent
+ *
+ * @return void
+ */
+void benchmarkRestrike() {
+  Pipeline pipeline;
+  pipeline.instrument->setRestrikeHeldNotes(true);
+  for(int key = 0; key < NUM_NOTE_PINS; key++) {
+    pipeline.keyEvents.push(FIRST_NOTE_PIN + key, HIGH, hostMicros);
+    pipeline.loop();
+  }
+  pipeline.click(OCTAVE_UP_PIN);
+  for(int key = 0; key < NUM_NOTE_PINS; key++) {
+    pipeline.keyEvents.push(FIRST_NOTE_PIN + key, LOW, hostMicros);
+    pipeline.loop();
+  }
+
+  printf("octave up with %d keys held and struck again: %lu MIDI events, %lu bytes\n", 
+    NUM_NOTE_PINS, Serial.byteCount / 3, Serial.byteCount);
+}
+
+/**
+ * Note ons and note offs decoded from the bytes written to the serial port during a scheduler workload, recording the 
+ * tick of every note on. Running status is off, so every MIDI event is three bytes
+ */
+struct NoteLog {
+  unsigned long decodedBytes; // Bytes written to the serial port which have been decoded
+  unsigned long startTick; // Tick the current phase of the workload started at
+  unsigned long ticks[MAX_LOGGED_NOTE_ONS]; // Ticks of the note ons in the current phase, from its start
+  int numNoteOns; // Number of note ons in the current phase
+  bool isSounding[NUM_MIDI_NOTES]; // Is each note left sounding
+
+  NoteLog() {
+    this->decodedBytes = Serial.byteCount;
+    for(int i = 0; i < NUM_MIDI_NOTES; i++) {
+      this->isSounding[i] = false;
+    }
+    this->start();
+  }
+
+  /**
+   * Start a new phase of the workload at the current tick
+   *
+   * @return void
+   */
+  void start() {
+    this->startTick = millis();
+    this->numNoteOns = 0;
+  }
+
+  /**
+   * Decode every MIDI event written since the last call
+   *
+   * @return void
+   */
+  void record() {
+    for(; this->decodedBytes + 3 <= Serial.byteCount; this->decodedBytes += 3) {
+      int status = Serial.lastBytes[this->decodedBytes & 0xFF] & 0xF0;
+      int note = Serial.lastBytes[(this->decodedBytes + 1) & 0xFF];
+      if(status == NOTEON) {
+        if(this->numNoteOns < MAX_LOGGED_NOTE_ONS) {
+          this->ticks[this->numNoteOns] = millis() - this->startTick;
+        }
+        this->numNoteOns++;
+        this->isSounding[note] = true;
+      } else if(status == NOTEOFF) {
+        this->isSounding[note] = false;
+      }
+    }
+  }
+
+  /**
+   * Print the note ons of the current phase and the notes left sounding, then start the next phase
+   *
+   * @params const char * phase The name of the phase
+   *
+   * @return void
+   */
+  void print(const char * phase) {
+    int numSounding = 0;
+    for(int i = 0; i < NUM_MIDI_NOTES; i++) {
+      numSounding += this->isSounding[i];
+    }
+    printf("  %s: %d note ons, %d notes left sounding, ticks", phase, this->numNoteOns, numSounding);
+    for(int i = 0; i < this->numNoteOns && i < MAX_LOGGED_NOTE_ONS; i++) {
+      printf(" %lu", this->ticks[i]);
+    }
+    printf("\n");
+    this->start();
+  }
+};
+
+/**
+ * Run the loop once every millisecond
+ *
+ * @params Pipeline & pipeline The pipeline to run
+ * @params NoteLog &  log      The log to record the note ons in
+ * @params int        ticks    The number of milliseconds to run for
+ *
+ * @return void
+ */
+void runTicks(Pipeline & pipeline, NoteLog & log, int ticks) {
+  for(int i = 0; i < ticks; i++) {
+    hostMicros += 1000;
+    pipeline.loop();
+    log.record();
+  }
+}
+
+/**
+ * Press or release a key and run the loop once
+ *
+ * @params Pipeline & pipeline The pipeline to play the key on
+ * @params NoteLog &  log      The log to record the note ons in
+ * @params int        pinIndex The index of the key's pin
+ * @params uint8_t    value    The new value of the key
+ *
+ * @return void
+ */
+void setKey(Pipeline & pipeline, NoteLog & log, int pinIndex, uint8_t value) {
+  pipeline.keyEvents.push(pinIndex, value, hostMicros);
+  pipeline.loop();
+  log.record();
+}
+
+/**
+ * Cycle the play mode by pressing octave down while octave up is held, then releasing both
+ *
+ * @params Pipeline & pipeline The pipeline to cycle the play mode of
+ * @params NoteLog &  log      The log to record the note ons in
+ *
+ * @return void
+ */
+void cyclePlayMode(Pipeline & pipeline, NoteLog & log) {
+  pipeline.controlValues[OCTAVE_UP_PIN] = HIGH;
+  pipeline.loop();
+  pipeline.controlValues[OCTAVE_DOWN_PIN] = HIGH;
+  pipeline.loop();
+  pipeline.controlValues[OCTAVE_UP_PIN] = LOW;
+  pipeline.controlValues[OCTAVE_DOWN_PIN] = LOW;
+  pipeline.loop();
+  log.record();
+}
+
+/**
+ * Hold keys in a scheduled play mode across a stalled loop, printing the tick of every note on. Missed repeats or 
+ * arpeggio steps are skipped rather than replayed as a burst, so the stall shows up as a single late note on followed 
+ * by the original phase. Releasing the keys, or cycling the play mode with the keys held, must cancel the scheduled 
+ * events, which shows up as no further note ons from the previous mode
+ *
+ * @params const char * name     The name of the play mode
+ * @params int          playMode The play mode to hold the keys in
+ * @params int          numKeys  The number of keys to hold
+ *
+ * @return void
+ */
+void benchmarkScheduledPlayMode(const char * name, int playMode, int numKeys) {
+  Pipeline pipeline;
+  NoteLog log;
+  for(int i = 0; i < playMode; i++) {
+    cyclePlayMode(pipeline, log);
+  }
+  printf("%s with %d %s held:\n", name, numKeys, numKeys == 1 ? "key" : "keys");
+
+  log.start();
+  for(int key = 0; key < numKeys; key++) {
+    setKey(pipeline, log, FIRST_NOTE_PIN + key, HIGH);
+  }
+  runTicks(pipeline, log, 300);
+  hostMicros += STALL_MILLIS * 1000;
+  runTicks(pipeline, log, 300);
+  log.print("held across a 600 ms stall");
+
+  for(int key = 0; key < numKeys; key++) {
+    setKey(pipeline, log, FIRST_NOTE_PIN + key, LOW);
+  }
+  runTicks(pipeline, log, STALL_MILLIS);
+  log.print("released");
+
+  for(int key = 0; key < numKeys; key++) {
+    setKey(pipeline, log, FIRST_NOTE_PIN + key, HIGH);
+  }
+  runTicks(pipeline, log, 200);
+  log.start();
+  while(playMode != NORMAL_PLAY_MODE) {
+    cyclePlayMode(pipeline, log);
+    playMode = (playMode + 1) % NUM_PLAY_MODES;
+  }
+  runTicks(pipeline, log, STALL_MILLIS);
+  log.print("held, then cycled round to normal mode");
+
+  for(int key = 0; key < numKeys; key++) {
+    setKey(pipeline, log, FIRST_NOTE_PIN + key, LOW);
+  }
+  log.print("released in normal mode");
+}
+
+int main() {
+  const int emptyOctaveUp[] = { OCTAVE_UP_PIN };
+  const int transpose[] = { TRANSPOSE_PIN };
+  const int octaveAndTranspose[] = { OCTAVE_UP_PIN, OCTAVE_DOWN_PIN, TRANSPOSE_PIN, TRANSPOSE_PIN };
+
+  benchmarkKeyPresses();
+  benchmarkKeyBounce();
+  benchmarkStalledLoop();
+  benchmarkStateChanges("octave up with no keys held", 1, 0, emptyOctaveUp, 1);
+  benchmarkStateChanges("transpose with two keys held", 1, 2, transpose, 1);
+  benchmarkStateChanges("octave and transpose changes with three keys held", 1000, 3, octaveAndTranspose, 4);
+  benchmarkRestrike();
+  benchmarkScheduledPlayMode("note repeat", REPEAT_PLAY_MODE, 1);
+  benchmarkScheduledPlayMode("arpeggiator", ARPEGGIATOR_PLAY_MODE, 2);
+  return 0;
+}
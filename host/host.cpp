@@ -0,0 +1,27 @@
+#include "Arduino.h"
+
+volatile uint8_t SREG, PCICR, PCMSK, TCCR2A, TCCR2B, TCNT2, OCR2A, TIMSK2;
+volatile uint8_t hostPinRegisters[NUM_HOST_PINS];
+unsigned long hostMicros = 0;
+HostSerial Serial;
+
+int digitalRead(int pin) {
+  return hostPinRegisters[pin] & 1;
+}
+
+int analogRead(int pin) {
+  return hostPinRegisters[pin];
+}
+
+void pinMode(int pin, int mode) {
+}
+
+void HostSerial::begin(unsigned long baud, int config) {
+  this->byteCount = 0;
+}
+
+size_t HostSerial::write(uint8_t value) {
+  this->lastBytes[this->byteCount & 0xFF] = value;
+  this->byteCount++;
+  return 1;
+}
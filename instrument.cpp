@@ -3,16 +3,31 @@
 /**
  * Constructor to set default values and initialize all pins with notes and controllers
  *
- * @params Pin * pins Array of pins to initialize with notes and controllers
+ * @params Pin *            pins       Array of pins to initialize with notes and controllers
+ * @params MidiEventQueue * midiEvents Queue to output MIDI events onto
  *
  * @return void 
  */
-Instrument::Instrument(Pin * pins) {
+Instrument::Instrument(Pin * pins, MidiEventQueue * midiEvents) {
+  this->pins = pins;
+  this->midiEvents = midiEvents;
+  this->nextControlPin = 0;
   this->isTranspose = false;
   this->channel = DEFAULT_CHANNEL;
   this->velocity = MAX_VELOCITY; // default to max in case this controller is not in use
   this->volume = MAX_VOLUME; // default to max in case this controller is not in use
   this->octaveShift = DEFAULT_OCTAVE_SHIFT;
+  this->playMode = DEFAULT_PLAY_MODE;
+  this->isRestrikeHeldNotes = DEFAULT_RESTRIKE_HELD_NOTES;
+  this->isRestrikePending = false;
+  this->isOctaveUpHeld = false;
+  this->isOctaveDownHeld = false;
+  this->isPlayModeChordHeld = false;
+  for(int i = 0; i < NUM_NOTE_PINS; i++) {
+    this->repeatHandles[i] = TIMER_WHEEL_NONE;
+  }
+  this->arpeggioHandle = TIMER_WHEEL_NONE;
+  this->arpeggioPin = -1;
   this->initializePins(pins);
 }
 
@@ -81,28 +96,71 @@ void Instrument::initializePins(Pin * pins) {
 
 
 /**
- * Take an action on all updated pin values by either outputting MIDI data or updating the instrument state
+ * Take an action on all updated control pin values, queued key events, and expired scheduled events by either 
+ * outputting MIDI data or updating the instrument state. Control pins are polled while note keys arrive through 
+ * the key event queue
  *
- * @params Pin * pins Array of pins to use to determine the appropriate instrument actions
+ * Every action is only taken once the MIDI event queue has room for the most events an action can produce. When it 
+ * does not, play() stops and returns false so the caller can drain the queue, and the next call resumes where it stopped.
+ * Held keys waiting to be struck again after a state change are struck as their own action before the next one
  *
- * @return void 
+ * @params KeyEventQueue * keyEvents Queue of key transitions captured by interrupts
+ *
+ * @return bool Has everything been played (false if the MIDI event queue must be drained before calling again)
  */
-void Instrument::play(Pin * pins) {
-  for(int i = 0; i < NUM_PINS_USED; i++) {
-    if(pins[i].isChanged()) {
-      resolveAction(pins[i]);
+bool Instrument::play(KeyEventQueue * keyEvents) {
+  while(this->nextControlPin < FIRST_NOTE_PIN) {
+    if(!this->isReadyForAction()) {
+      return false;
+    }
+    int pinIndex = this->nextControlPin++;
+    if(this->pins[pinIndex].isChanged()) {
+      this->resolveAction(pinIndex);
     }
   }
+
+  KeyEvent keyEvent;
+  while(this->isReadyForAction() && keyEvents->pop(&keyEvent)) {
+    this->pins[keyEvent.pinIndex].setValue(keyEvent.value);
+    this->resolveAction(keyEvent.pinIndex);
+  }
+  if(!this->isReadyForAction()) {
+    return false;
+  }
+
+  TimerEvent timerEvent;
+  this->scheduler.advance(TimerWheel::getTick());
+  while(this->isReadyForAction() && this->scheduler.pop(&timerEvent)) {
+    this->resolveTimerEvent(timerEvent);
+  }
+  if(!this->isReadyForAction()) {
+    return false;
+  }
+
+  this->nextControlPin = 0;
+  return true;
+}
+
+/**
+ * Set whether held keys are struck again at their new pitch or channel after a state change
+ *
+ * @params bool isRestrikeHeldNotes Should held keys be struck again
+ *
+ * @return void 
+ */
+void Instrument::setRestrikeHeldNotes(bool isRestrikeHeldNotes) {
+  this->isRestrikeHeldNotes = isRestrikeHeldNotes;
 }
 
 /**
  * Use the pin number to determine the appropriate action and execute it
  *
- * @params Pin pin The pin to use to determine the appropriate course of action
+ * @params int pinIndex The index of the pin to use to determine the appropriate course of action
  *
  * @return void 
  */
-void Instrument::resolveAction(Pin pin) {
+void Instrument::resolveAction(int pinIndex) {
+  Pin pin = this->pins[pinIndex];
   switch(pin.getPinNumber()) {
     case OCTAVE_UP_PIN:
       this->setOctaveUp(pin.getValue() == LOW);
@@ -132,7 +190,25 @@ void Instrument::resolveAction(Pin pin) {
       this->setSustain((Controller *)pin.getMidiProperty(), pin.getValue());
       break;
     default:
-      this->setNote((Note *)pin.getMidiProperty(), pin.getValue() == HIGH);
+      this->setNote(pinIndex, pin.getValue() == HIGH);
+  }
+}
+
+/**
+ * Use the event type to determine the appropriate action for an expired scheduled event and execute it
+ *
+ * @params TimerEvent event The expired scheduled event
+ *
+ * @return void 
+ */
+void Instrument::resolveTimerEvent(TimerEvent event) {
+  switch(event.type) {
+    case NOTE_REPEAT_EVENT:
+      this->repeatNote(event);
+      break;
+    case ARPEGGIO_STEP_EVENT:
+      this->stepArpeggio(event);
+      break;
   }
 }
 
@@ -144,10 +220,15 @@ void Instrument::resolveAction(Pin pin) {
  * @return void 
  */
 void Instrument::setOctaveUp(bool isOctaveUpReleased) {
+  this->isOctaveUpHeld = !isOctaveUpReleased;
+  if(this->isPlayModeChord(isOctaveUpReleased, this->isOctaveDownHeld)) {
+    return;
+  }
   // Only increment the octave on release of the octave up button when the octave is in range
   if(isOctaveUpReleased && this->octaveShift < MAX_OCTAVE_SHIFT_UP) {
-    this->allNotesOff();
+    this->releaseActiveNotes();
     this->octaveShift++;
+    this->restrikeHeldNotes();
   }
 }
 
@@ -159,13 +240,56 @@ void Instrument::setOctaveUp(bool isOctaveUpReleased) {
  * @return void 
  */
 void Instrument::setOctaveDown(bool isOctaveDownReleased) {
+  this->isOctaveDownHeld = !isOctaveDownReleased;
+  if(this->isPlayModeChord(isOctaveDownReleased, this->isOctaveUpHeld)) {
+    return;
+  }
   // Only dencrement the octave on release of the octave up button when the octave is in range
   if(isOctaveDownReleased && this->octaveShift > MAX_OCTAVE_SHIFT_DOWN) {
-    this->allNotesOff();
+    this->releaseActiveNotes();
     this->octaveShift--;
+    this->restrikeHeldNotes();
   }
 }
 
+/**
+ * Cycle the play mode when one octave button is pressed while the other is held. The octave buttons do not shift 
+ * the octave again until both have been released
+ *
+ * @params bool isReleased  Is the octave button being released
+ * @params bool isOtherHeld Is the other octave button held down
+ *
+ * @return bool Is the octave button part of a play mode chord
+ */
+bool Instrument::isPlayModeChord(bool isReleased, bool isOtherHeld) {
+  if(!isReleased && isOtherHeld) {
+    this->cyclePlayMode();
+    this->isPlayModeChordHeld = true;
+  } else if(isReleased && this->isPlayModeChordHeld) {
+    this->isPlayModeChordHeld = isOtherHeld;
+    return true;
+  }
+  return this->isPlayModeChordHeld;
+}
+
+/**
+ * Switch to the next play mode, stopping all scheduled notes from the previous mode. Held keys are struck again in 
+ * the new mode by play() as a separate action once the MIDI event queue has room for them
+ *
+ * @return void 
+ */
+void Instrument::cyclePlayMode() {
+  this->scheduler.cancelAll();
+  for(int i = 0; i < NUM_NOTE_PINS; i++) {
+    this->repeatHandles[i] = TIMER_WHEEL_NONE;
+  }
+  this->arpeggioHandle = TIMER_WHEEL_NONE;
+  this->arpeggioPin = -1;
+  this->releaseActiveNotes();
+  this->playMode = (this->playMode + 1) % NUM_PLAY_MODES;
+  this->isRestrikePending = true;
+}
+
 /**
  * Toggle the transpose state
  *
@@ -175,8 +299,9 @@ void Instrument::setOctaveDown(bool isOctaveDownReleased) {
  */
 void Instrument::setTranspose(bool isTransposeReleased) {
   if(isTransposeReleased) {
-    this->allNotesOff();
+    this->releaseActiveNotes();
     this->isTranspose = !this->isTranspose;
+    this->restrikeHeldNotes();
   }
 }
 
@@ -201,8 +326,9 @@ void Instrument::setVelocity(int value) {
 void Instrument::setChannel(int value) {
   int newChannel = this->fitToRange(value, 0, NUM_CHANNELS - 1);
   if(this->channel != newChannel) {
-    this->allNotesOff();
+    this->releaseActiveNotes();
     this->channel = newChannel;
+    this->restrikeHeldNotes();
   }
 }
 
@@ -216,9 +342,7 @@ void Instrument::setChannel(int value) {
  */
 void Instrument::setPitchBend(Controller * controller, int value) {
   int pitchBend = this->fitToRange(value, 0, MAX_PITCH_BEND);
-  Serial.write(controller->getMidiMessage(this->channel));
-  Serial.write(pitchBend & 0x7F);
-  Serial.write((pitchBend >> 8) & 0x7F);
+  this->sendEvent(controller->getMidiMessage(this->channel), pitchBend & 0x7F, (pitchBend >> 8) & 0x7F);
 }
 
 /**
@@ -258,52 +382,220 @@ void Instrument::setSustain(Controller * controller, int state) {
 }
 
 /**
- * Set a note state (note on vs not off)
+ * Set a note state (note on vs not off) and play it according to the play mode
  *
- * @params Note * note  The note that the pin controls
- * @params bool   value The value of the pin
+ * @params int  pinIndex The index of the pin controlling the note
+ * @params bool value    The value of the pin
  *
  * @return void 
  */
-void Instrument::setNote(Note * note, bool value) {
-  value ? this->noteOn(note) : this->noteOff(note);
+void Instrument::setNote(int pinIndex, bool value) {
+  Note * note = (Note *)this->pins[pinIndex].getMidiProperty();
+  note->setState(value);
+  switch(this->playMode) {
+    case REPEAT_PLAY_MODE:
+      value ? this->startNoteRepeat(pinIndex) : this->stopNoteRepeat(pinIndex);
+      break;
+    case ARPEGGIATOR_PLAY_MODE:
+      value ? this->startArpeggio() : this->releaseArpeggioKey(pinIndex);
+      break;
+    default:
+      value ? this->noteOn(note) : this->noteOff(note);
+  }
 } 
 
 /**
- * Send a note on message
+ * Play a held key's note and schedule its first repeat
+ *
+ * @params int pinIndex The index of the pin controlling the note
+ *
+ * @return void 
+ */
+void Instrument::startNoteRepeat(int pinIndex) {
+  this->noteOn((Note *)this->pins[pinIndex].getMidiProperty());
+  this->repeatHandles[pinIndex - FIRST_NOTE_PIN] = 
+    this->scheduler.schedule(TimerWheel::getTick() + NOTE_REPEAT_INTERVAL, NOTE_REPEAT_EVENT, pinIndex);
+}
+
+/**
+ * Cancel a released key's next repeat and release its note
+ *
+ * @params int pinIndex The index of the pin controlling the note
+ *
+ * @return void 
+ */
+void Instrument::stopNoteRepeat(int pinIndex) {
+  this->scheduler.cancel(this->repeatHandles[pinIndex - FIRST_NOTE_PIN]);
+  this->repeatHandles[pinIndex - FIRST_NOTE_PIN] = TIMER_WHEEL_NONE;
+  this->noteOff((Note *)this->pins[pinIndex].getMidiProperty());
+}
+
+/**
+ * Re-strike a held key's note. The next repeat keeps the phase of the tick this repeat was due, so a late loop 
+ * neither pushes every following repeat back nor replays the missed repeats as a burst
+ *
+ * @params TimerEvent event The expired repeat event
+ *
+ * @return void 
+ */
+void Instrument::repeatNote(TimerEvent event) {
+  Note * note = (Note *)this->pins[event.data].getMidiProperty();
+  this->noteOff(note);
+  this->noteOn(note);
+  this->repeatHandles[event.data - FIRST_NOTE_PIN] = 
+    this->scheduler.schedulePeriodic(event.tick, NOTE_REPEAT_INTERVAL, NOTE_REPEAT_EVENT, event.data);
+}
+
+/**
+ * Start the arpeggiator on the current tick if it is not already running
+ *
+ * @return void 
+ */
+void Instrument::startArpeggio() {
+  if(this->arpeggioHandle == TIMER_WHEEL_NONE) {
+    this->arpeggioHandle = this->scheduler.schedule(TimerWheel::getTick(), ARPEGGIO_STEP_EVENT, 0);
+  }
+}
+
+/**
+ * Release the arpeggiator's note if it belongs to the released key, and stop the arpeggiator once no keys are held. 
+ * Other released keys are skipped by the next arpeggio step
+ *
+ * @params int pinIndex The index of the pin controlling the released note
+ *
+ * @return void 
+ */
+void Instrument::releaseArpeggioKey(int pinIndex) {
+  if(pinIndex == this->arpeggioPin) {
+    this->noteOff((Note *)this->pins[pinIndex].getMidiProperty());
+    this->arpeggioPin = -1;
+  }
+  if(this->getNextHeldPin(-1) < 0) {
+    this->scheduler.cancel(this->arpeggioHandle);
+    this->arpeggioHandle = TIMER_WHEEL_NONE;
+  }
+}
+
+/**
+ * Release the arpeggiator's current note and play the next held key. The arpeggiator stops once no keys are held. 
+ * The next step keeps the phase of the tick this step was due, so a late loop neither pushes every following step 
+ * back nor replays the missed steps as a burst
+ *
+ * @params TimerEvent event The expired arpeggio step event
+ *
+ * @return void 
+ */
+void Instrument::stepArpeggio(TimerEvent event) {
+  this->arpeggioHandle = TIMER_WHEEL_NONE;
+  if(this->arpeggioPin >= 0) {
+    this->noteOff((Note *)this->pins[this->arpeggioPin].getMidiProperty());
+  }
+
+  this->arpeggioPin = this->getNextHeldPin(this->arpeggioPin);
+  if(this->arpeggioPin >= 0) {
+    this->noteOn((Note *)this->pins[this->arpeggioPin].getMidiProperty());
+    this->arpeggioHandle = this->scheduler.schedulePeriodic(event.tick, ARPEGGIO_INTERVAL, ARPEGGIO_STEP_EVENT, 0);
+  }
+}
+
+/**
+ * Find the next held key after the provided pin in key order, wrapping around to the first key
+ *
+ * @params int pinIndex The index of the pin to search from (-1 to search from the first key)
+ *
+ * @return int The index of the next held key's pin (-1 if no keys are held)
+ */
+int Instrument::getNextHeldPin(int pinIndex) {
+  int key = pinIndex < 0 ? NUM_NOTE_PINS - 1 : pinIndex - FIRST_NOTE_PIN;
+  for(int i = 1; i <= NUM_NOTE_PINS; i++) {
+    int nextPinIndex = FIRST_NOTE_PIN + (key + i) % NUM_NOTE_PINS;
+    if(((Note *)this->pins[nextPinIndex].getMidiProperty())->getIsActive()) {
+      return nextPinIndex;
+    }
+  }
+  return -1;
+}
+
+/**
+ * Send a note on message and mark the note as sounding
  *
  * @params Note * note  The note that the pin controls
  *
  * @return void 
  */
 void Instrument::noteOn(Note * note) {
-  Serial.write(NOTEON + this->channel);
-  Serial.write(note->getValue(this->octaveShift, this->isTranspose));
-  Serial.write(this->velocity); 
+  int value = note->getValue(this->octaveShift, this->isTranspose);
+  this->sendEvent(NOTEON + this->channel, value, this->velocity);
+  this->activeNotes.set(value);
 }
 
 /**
- * Send a note off message
+ * Send a note off message if the note is sounding. A note which was already released by a state change 
+ * is not sent again
  *
  * @params Note * note  The note that the pin controls
  *
  * @return void 
  */
 void Instrument::noteOff(Note * note) {
-  Serial.write(NOTEOFF + this->channel);
-  Serial.write(note->getValue(this->octaveShift, this->isTranspose));
-  Serial.write(0);
+  int value = note->getValue(this->octaveShift, this->isTranspose);
+  if(this->activeNotes.isActive(value)) {
+    this->sendEvent(NOTEOFF + this->channel, value, 0);
+    this->activeNotes.clear(value);
+  }
 }
 
 /**
- * Send a channel wide all notes off message
+ * Send a note off message for exactly the notes sounding on the current channel. Nothing is sent when no notes 
+ * are sounding. Unlike a channel wide all notes off message, these are honoured by synths while sustain is down
  *
  * @return void 
  */
-void Instrument::allNotesOff() {
-  Serial.write(CONTROL_CHANGE + this->channel);
-  Serial.write(ALL_NOTES_OFF);
-  Serial.write(0);  
+void Instrument::releaseActiveNotes() {
+  if(this->activeNotes.isEmpty()) {
+    return;
+  }
+  for(int value = 0; value < NUM_MIDI_NOTES; value++) {
+    if(this->activeNotes.isActive(value)) {
+      this->sendEvent(NOTEOFF + this->channel, value, 0);
+      this->activeNotes.clear(value);
+    }
+  }
+}
+
+/**
+ * Queue striking the notes of all held keys again after a state change so they keep sounding at their new pitch or 
+ * channel. They are struck by play() as a separate action once the MIDI event queue has room for them. Only applies 
+ * in normal play mode as the repeat and arpeggiator modes strike held keys on their next scheduled event
+ *
+ * @return void 
+ */
+void Instrument::restrikeHeldNotes() {
+  if(this->isRestrikeHeldNotes && this->playMode == NORMAL_PLAY_MODE) {
+    this->isRestrikePending = true;
+  }
+}
+
+/**
+ * Strike every held key according to the play mode: a note on in normal mode, a note on and its first repeat in 
+ * repeat mode, or the arpeggiator if any key is held in arpeggiator mode
+ *
+ * @return void 
+ */
+void Instrument::strikeHeldNotes() {
+  if(this->playMode == ARPEGGIATOR_PLAY_MODE) {
+    if(this->getNextHeldPin(-1) >= 0) {
+      this->startArpeggio();
+    }
+    return;
+  }
+
+  for(int i = FIRST_NOTE_PIN; i < NUM_PINS_USED; i++) {
+    Note * note = (Note *)this->pins[i].getMidiProperty();
+    if(note->getIsActive()) {
+      this->playMode == REPEAT_PLAY_MODE ? this->startNoteRepeat(i) : this->noteOn(note);
+    }
+  }
 }
 
 /**
@@ -315,9 +607,47 @@ void Instrument::allNotesOff() {
  * @return void 
  */
 void Instrument::sendControllerAction(Controller * controller, int scaledValue) {
-  Serial.write(controller->getMidiMessage(this->channel));
-  Serial.write(controller->getControllerNumber());
-  Serial.write(scaledValue);
+  this->sendEvent(controller->getMidiMessage(this->channel), controller->getControllerNumber(), scaledValue);
+}
+
+/**
+ * Queue a MIDI event for the transmitter. play() only takes an action once the queue has room for all of its 
+ * events, so the push cannot fail
+ *
+ * @params int status The MIDI message combined with the channel
+ * @params int data1  The first data byte
+ * @params int data2  The second data byte
+ *
+ * @return void 
+ */
+void Instrument::sendEvent(int status, int data1, int data2) {
+  this->midiEvents->push(status, data1, data2);
+}
+
+/**
+ * Does the MIDI event queue have room for the MIDI events of any single action
+ *
+ * @return bool
+ */
+bool Instrument::hasEventSpace() {
+  return this->midiEvents->getFreeCount() >= MAX_MIDI_EVENTS_PER_ACTION;
+}
+
+/**
+ * Strike any held keys waiting to be struck again after a state change, then check the MIDI event queue has room 
+ * for the next action
+ *
+ * @return bool Is there room for the next action
+ */
+bool Instrument::isReadyForAction() {
+  if(!this->hasEventSpace()) {
+    return false;
+  }
+  if(this->isRestrikePending) {
+    this->isRestrikePending = false;
+    this->strikeHeldNotes();
+  }
+  return this->hasEventSpace();
 }
 
 /**
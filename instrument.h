@@ -1,6 +1,6 @@
 /**
  * Instrument class which performs the bulk of the logic. Uses the updated pin states to update the instrument 
- * state and send all relevant MIDI messages
+ * state and queue all relevant MIDI events for the MIDI transmitter
  */
 
 #ifndef INSTRUMENT_H   /* Include guard */
@@ -11,6 +11,10 @@
 #include "pin.h"
 #include "Arduino.h"
 #include "midi_consts.h"
+#include "key_event_queue.h"
+#include "timer_wheel.h"
+#include "midi_event_queue.h"
+#include "active_notes.h"
 
 // Instrument pin constants
 const int NUM_PINS = 64;
@@ -24,6 +28,8 @@ const int PITCH_BEND_PIN = 5;
 const int VOLUME_PIN = 6;
 const int MOD_PIN = 7;
 const int SUSTAIN_PIN = 8;
+const int FIRST_NOTE_PIN = 9; // All pins from here up to NUM_PINS_USED are note keys
+const int NUM_NOTE_PINS = NUM_PINS_USED - FIRST_NOTE_PIN;
 
 // Instrument specific constants
 const int NUM_CHANNELS = 16;
@@ -31,30 +37,70 @@ const int MAX_OCTAVE_SHIFT_DOWN = -3; // We are limited to one less downshift be
 const int MAX_OCTAVE_SHIFT_UP = 4;
 const int DEFAULT_CHANNEL = 0;
 const int DEFAULT_OCTAVE_SHIFT = 0;
+const bool DEFAULT_RESTRIKE_HELD_NOTES = false; // Strike held keys again at their new pitch or channel after a state change
+// Most MIDI events a single action can queue: a note off for every sounding note, or a note on for every held key.
+// Striking held keys again after a state change is queued as its own action so the two are never combined
+const int MAX_MIDI_EVENTS_PER_ACTION = NUM_NOTE_PINS;
+static_assert(MIDI_EVENT_QUEUE_SIZE >= MAX_MIDI_EVENTS_PER_ACTION, "MIDI event queue cannot hold a single action");
+
+// Play modes, cycled by pressing the octave up and octave down buttons together
+const int NORMAL_PLAY_MODE = 0; // Keys play and release their notes directly
+const int REPEAT_PLAY_MODE = 1; // Held keys are re-struck every NOTE_REPEAT_INTERVAL
+const int ARPEGGIATOR_PLAY_MODE = 2; // Held keys are played one at a time in key order every ARPEGGIO_INTERVAL
+const int NUM_PLAY_MODES = 3;
+const int DEFAULT_PLAY_MODE = NORMAL_PLAY_MODE;
+const unsigned long NOTE_REPEAT_INTERVAL = 125; // Timer ticks (ms) between note repeats
+const unsigned long ARPEGGIO_INTERVAL = 125; // Timer ticks (ms) between arpeggio steps
+
+// Scheduled event types
+const uint8_t NOTE_REPEAT_EVENT = 0;
+const uint8_t ARPEGGIO_STEP_EVENT = 1;
 
 
 class Instrument {
   public:
-    // Constructor: Set default values and initialize all provided pins with notes and controllers
-    Instrument(Pin * pins);
-    // Use the pins array to take action on all updated pin values by either outputting MIDI data or updating the instrument state
-    void play(Pin * pins);
+    // Constructor: Set default values, initialize all provided pins with notes and controllers, and set the MIDI event queue to output onto
+    Instrument(Pin * pins, MidiEventQueue * midiEvents);
+    // Take action on all updated control pin values, queued key events, and expired scheduled events, returning false if the MIDI event queue must be drained first
+    bool play(KeyEventQueue * keyEvents);
+    // Set whether held keys are struck again at their new pitch or channel after a state change
+    void setRestrikeHeldNotes(bool isRestrikeHeldNotes);
   
   private:
+    Pin * pins; // Array of pins the instrument was initialized with
+    MidiEventQueue * midiEvents; // Queue of MIDI events waiting for the transmitter
+    int nextControlPin; // Control pin play() resumes from after stopping for a full MIDI event queue
     bool isTranspose; // Is the instrument in transpose mode
     int channel; // MIDI channel for the instrument
     int velocity; // Note velocity applied universally to the instrument (individual notes are not velocity sensitive)
     int volume; // Volume for the instrument
     int octaveShift; // The number of octaves the instrument has been shifted up or down
+    int playMode; // How held keys are played
+    bool isRestrikeHeldNotes; // Are held keys struck again after a state change
+    bool isRestrikePending; // Are held keys waiting to be struck again once the MIDI event queue has room
+    bool isOctaveUpHeld; // Is the octave up button held down
+    bool isOctaveDownHeld; // Is the octave down button held down
+    bool isPlayModeChordHeld; // Have both octave buttons been pressed together without being fully released yet
+    TimerWheel scheduler; // Scheduled note repeats and arpeggio steps
+    uint8_t repeatHandles[NUM_NOTE_PINS]; // Scheduled repeat of each held key in repeat mode
+    uint8_t arpeggioHandle; // Scheduled next arpeggio step
+    int arpeggioPin; // Index of the pin whose note the arpeggiator is sounding (-1 if none)
+    ActiveNotes activeNotes; // MIDI notes on the current channel sent a note on without a matching note off
 
     // Initialize all the pins with notes and controllers
     void initializePins(Pin * pins);
     // Perform the appropriate pin action by updating pin state and sending necessary MIDI messages
-    void resolveAction(Pin pin);
+    void resolveAction(int pinIndex);
+    // Perform the appropriate action for an expired scheduled event
+    void resolveTimerEvent(TimerEvent event);
     // Shift the instrument one octave up
     void setOctaveUp(bool isOctaveUpReleased);
     // Shift the instrument one octave down
     void setOctaveDown(bool isOctaveDownReleased);
+    // Cycle the play mode when both octave buttons are pressed together, returning true while the chord is held
+    bool isPlayModeChord(bool isReleased, bool isOtherHeld);
+    // Switch to the next play mode
+    void cyclePlayMode();
     // Toggle the instrument transpose state
     void setTranspose(bool isTransposeReleased);
     // Set the instrument's universal note velocity
@@ -70,15 +116,39 @@ class Instrument {
     // Toggle the instrument sustation mode
     void setSustain(Controller * controller, int state);
     // Toggle a note on or off
-    void setNote(Note * note, bool value);
+    void setNote(int pinIndex, bool value);
+    // Start re-striking a held key's note
+    void startNoteRepeat(int pinIndex);
+    // Stop re-striking a released key's note
+    void stopNoteRepeat(int pinIndex);
+    // Re-strike a held key's note and schedule the next repeat
+    void repeatNote(TimerEvent event);
+    // Start the arpeggiator if it is not already running
+    void startArpeggio();
+    // Release the arpeggiator's note when its key is released and stop the arpeggiator once no keys are held
+    void releaseArpeggioKey(int pinIndex);
+    // Move the arpeggiator on to the next held key and schedule the next step
+    void stepArpeggio(TimerEvent event);
+    // Find the next held key after the provided pin in key order
+    int getNextHeldPin(int pinIndex);
     // Send a note on MIDI message
     void noteOn(Note * note);
     // Send a not off MIDI message
     void noteOff(Note * note);
-    // Send a channel wide all notes off MIDI message
-    void allNotesOff();
+    // Send a note off MIDI message for every sounding note on the channel
+    void releaseActiveNotes();
+    // Queue striking the held keys again after a state change
+    void restrikeHeldNotes();
+    // Strike every held key according to the play mode
+    void strikeHeldNotes();
     // Send a controller action message
     void sendControllerAction(Controller * controller, int scaledValue);
+    // Queue a MIDI event for the transmitter
+    void sendEvent(int status, int data1, int data2);
+    // Does the MIDI event queue have room for the MIDI events of any single action
+    bool hasEventSpace();
+    // Strike any held keys waiting to be struck again and check there is room for the next action
+    bool isReadyForAction();
     // Fit the value to the range by scaling with the provided values
     int fitToRange(int value, int minValue, int maxValue);
 };
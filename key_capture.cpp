@@ -0,0 +1,137 @@
+#include "key_capture.h"
+
+static KeyCapture * activeCapture = NULL; // The capture serviced by the interrupt handlers
+
+/**
+ * Record the input register and bit mask of every note key and enable the interrupts that capture them.
+ * Keys start out released so any key held down at power on is queued on the first scan
+ *
+ * @params Pin *           pins  Array of initialized pins containing the note keys
+ * @params KeyEventQueue * queue Queue to push the captured key events onto
+ *
+ * @return void
+ */
+void KeyCapture::begin(Pin * pins, KeyEventQueue * queue) {
+  this->queue = queue;
+  this->droppedCount = 0;
+  for(int i = 0; i < NUM_NOTE_PINS; i++) {
+    int pinNumber = pins[FIRST_NOTE_PIN + i].getPinNumber();
+    this->inputRegisters[i] = portInputRegister(digitalPinToPort(pinNumber));
+    this->bitMasks[i] = digitalPinToBitMask(pinNumber);
+    this->values[i] = LOW;
+    this->isLockedOut[i] = false;
+    this->isPending[i] = false;
+  }
+
+  uint8_t oldSREG = SREG;
+  cli();
+  activeCapture = this;
+  for(int i = 0; i < NUM_NOTE_PINS; i++) {
+    this->enablePinChangeInterrupt(pins[FIRST_NOTE_PIN + i].getPinNumber());
+  }
+  this->enableScanTimer();
+  SREG = oldSREG;
+}
+
+/**
+ * Compare every note key against its last queued value and queue any transitions. A key's value is only
+ * updated once its event is queued, so a transition rejected by a full queue is picked up again on the next scan.
+ * Each rejected transition is counted as dropped once, however many scans it waits for room
+ *
+ * Once a transition is queued the key is locked out for KEY_DEBOUNCE_MICROS so its contact bounce is not queued as 
+ * further transitions. The timer scan runs every millisecond, so a lockout always ends long before the 16 bit 
+ * timestamp it started at wraps around
+ *
+ * @return void
+ */
+void KeyCapture::scan() {
+  unsigned long timestamp = micros();
+  for(uint8_t i = 0; i < NUM_NOTE_PINS; i++) {
+    if(this->isLockedOut[i]) {
+      if((uint16_t)((uint16_t)timestamp - this->lockoutStarts[i]) < KEY_DEBOUNCE_MICROS) {
+        continue;
+      }
+      this->isLockedOut[i] = false;
+    }
+
+    uint8_t value = (*this->inputRegisters[i] & this->bitMasks[i]) ? HIGH : LOW;
+    if(value == this->values[i]) {
+      this->isPending[i] = false; // A pending transition which reverted before it was queued is lost
+    } else if(this->queue->push(FIRST_NOTE_PIN + i, value, timestamp)) {
+      this->values[i] = value;
+      this->isLockedOut[i] = true;
+      this->lockoutStarts[i] = (uint16_t)timestamp;
+      this->isPending[i] = false;
+    } else if(!this->isPending[i]) {
+      this->droppedCount++;
+      this->isPending[i] = true;
+    }
+  }
+}
+
+/**
+ * Get the number of key transitions which could not be queued when they happened because the queue was full.
+ * The serial port carries MIDI, so this is read by the host benchmark or a debugger rather than printed
+ *
+ * @return unsigned int The number of dropped key transitions
+ */
+unsigned int KeyCapture::getDroppedCount() {
+  // The count is wider than a byte so read it with interrupts disabled to avoid a torn read
+  uint8_t oldSREG = SREG;
+  cli();
+  unsigned int droppedCount = this->droppedCount;
+  SREG = oldSREG;
+  return droppedCount;
+}
+
+/**
+ * Enable the pin change interrupt for a pin. Pins without one are left to the timer scan
+ *
+ * @params int pinNumber The number of the pin on the Arduino
+ *
+ * @return void
+ */
+void KeyCapture::enablePinChangeInterrupt(int pinNumber) {
+  volatile uint8_t * controlRegister = digitalPinToPCICR(pinNumber);
+  if(controlRegister != NULL) {
+    *controlRegister |= _BV(digitalPinToPCICRbit(pinNumber));
+    *digitalPinToPCMSK(pinNumber) |= _BV(digitalPinToPCMSKbit(pinNumber));
+  }
+}
+
+/**
+ * Start Timer2 in CTC mode at 1 kHz (16 MHz / 64 / 250) to scan every key.
+ * This takes Timer2 away from PWM, which is fine as none of the instrument's pins are outputs
+ *
+ * @return void
+ */
+void KeyCapture::enableScanTimer() {
+  TCCR2A = _BV(WGM21);
+  TCCR2B = _BV(CS22);
+  TCNT2 = 0;
+  OCR2A = 249;
+  TIMSK2 |= _BV(OCIE2A);
+}
+
+// All interrupts simply rescan every key, which keeps the handlers independent of how keys are wired to ports
+#ifdef PCINT0_vect
+ISR(PCINT0_vect) {
+  activeCapture->scan();
+}
+#endif
+
+#ifdef PCINT1_vect
+ISR(PCINT1_vect) {
+  activeCapture->scan();
+}
+#endif
+
+#ifdef PCINT2_vect
+ISR(PCINT2_vect) {
+  activeCapture->scan();
+}
+#endif
+
+ISR(TIMER2_COMPA_vect) {
+  activeCapture->scan();
+}
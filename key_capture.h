@@ -0,0 +1,46 @@
+/**
+ * Interrupt driven capture of the note keys. Key transitions are timestamped and pushed onto a key event
+ * queue from interrupt context so key detection latency does not depend on the length of the main loop
+ *
+ * Keys on pins with a pin change interrupt are captured the moment they change. Every key is also scanned from a
+ * 1 kHz hardware timer interrupt, which covers the pins without a pin change interrupt and ends debounce lockouts
+ */
+
+#ifndef KEY_CAPTURE_H   /* Include guard */
+#define KEY_CAPTURE_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "pin.h"
+#include "instrument.h"
+#include "key_event_queue.h"
+
+const uint16_t KEY_DEBOUNCE_MICROS = 5000; // Time a key's contacts are ignored for after one of its transitions is queued
+
+class KeyCapture {
+  public:
+    // Record the port of every note key and enable the interrupts that capture them
+    void begin(Pin * pins, KeyEventQueue * queue);
+    // Compare every note key against its last known value and queue any transitions. Called from interrupt context
+    void scan();
+    // Get the number of key transitions which could not be queued when they happened
+    unsigned int getDroppedCount();
+
+  private:
+    KeyEventQueue * queue; // Queue the captured key events are pushed onto
+    volatile uint8_t * inputRegisters[NUM_NOTE_PINS]; // Input register of each key's port
+    uint8_t bitMasks[NUM_NOTE_PINS]; // Bit of each key within its port
+    uint8_t values[NUM_NOTE_PINS]; // Last value queued for each key
+    bool isLockedOut[NUM_NOTE_PINS]; // Is each key ignored while its contacts settle
+    uint16_t lockoutStarts[NUM_NOTE_PINS]; // Low bits of the timestamp each key's lockout started at
+    bool isPending[NUM_NOTE_PINS]; // Is each key waiting for room in the queue for a transition already counted as dropped
+    volatile unsigned int droppedCount; // Number of key transitions which could not be queued when they happened
+
+    // Enable the pin change interrupt for a pin
+    void enablePinChangeInterrupt(int pinNumber);
+    // Start the hardware timer which scans every key
+    void enableScanTimer();
+};
+
+#endif // KEY_CAPTURE_H
@@ -0,0 +1,57 @@
+#include "key_event_queue.h"
+#include "Arduino.h"
+
+/**
+ * Constructor to start with an empty queue
+ *
+ * @return void
+ */
+KeyEventQueue::KeyEventQueue() {
+  this->head = 0;
+  this->tail = 0;
+}
+
+/**
+ * Add a key event to the queue. The event is written before the head is published so the consumer
+ * never reads a partially written event
+ *
+ * @params uint8_t       pinIndex  The index of the key's pin in the pins array
+ * @params uint8_t       value     The new digital value of the key
+ * @params unsigned long timestamp The time of the transition in microseconds
+ *
+ * @return bool Was the event queued (false if the queue was full)
+ */
+bool KeyEventQueue::push(uint8_t pinIndex, uint8_t value, unsigned long timestamp) {
+  uint8_t head = this->head;
+  if((uint8_t)(head - this->tail) >= KEY_EVENT_QUEUE_SIZE) {
+    return false;
+  }
+
+  KeyEvent * event = &this->events[head & (KEY_EVENT_QUEUE_SIZE - 1)];
+  event->pinIndex = pinIndex;
+  event->value = value;
+  event->timestamp = timestamp;
+  asm volatile("" ::: "memory"); // Keep the event writes ahead of publishing the head
+  this->head = head + 1;
+  return true;
+}
+
+/**
+ * Remove the oldest key event from the queue. The event is copied out before the tail is released
+ * so the producer never overwrites an event that is still being read
+ *
+ * @params KeyEvent * event The key event to copy the oldest event into
+ *
+ * @return bool Was an event removed (false if the queue was empty)
+ */
+bool KeyEventQueue::pop(KeyEvent * event) {
+  uint8_t tail = this->tail;
+  if(tail == this->head) {
+    return false;
+  }
+
+  *event = this->events[tail & (KEY_EVENT_QUEUE_SIZE - 1)];
+  asm volatile("" ::: "memory"); // Keep the event reads ahead of releasing the tail
+  this->tail = tail + 1;
+  return true;
+}
@@ -0,0 +1,37 @@
+/**
+ * Single producer/single consumer queue of key transitions. Key transitions are pushed from interrupt
+ * context and popped from the main loop without either side having to disable interrupts
+ */
+
+#ifndef KEY_EVENT_QUEUE_H   /* Include guard */
+#define KEY_EVENT_QUEUE_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+const uint8_t KEY_EVENT_QUEUE_SIZE = 32; // Must be a power of two
+
+// A single key transition
+struct KeyEvent {
+  uint8_t pinIndex; // Index of the key's pin in the pins array
+  uint8_t value; // The new digital value of the key
+  unsigned long timestamp; // Time of the transition in microseconds
+};
+
+class KeyEventQueue {
+  public:
+    // Constructor: Start with an empty queue
+    KeyEventQueue();
+    // Add a key event to the queue. Must only be called by the producer (interrupt context)
+    bool push(uint8_t pinIndex, uint8_t value, unsigned long timestamp);
+    // Remove the oldest key event from the queue. Must only be called by the consumer (main loop)
+    bool pop(KeyEvent * event);
+
+  private:
+    KeyEvent events[KEY_EVENT_QUEUE_SIZE]; // Ring of queued key events
+    volatile uint8_t head; // Free running write index, only modified by the producer
+    volatile uint8_t tail; // Free running read index, only modified by the consumer
+};
+
+#endif // KEY_EVENT_QUEUE_H
@@ -18,6 +18,7 @@ const int VOLUME_CONTROL = 0x07;
 const int SUSTAIN_CONTROL = 0x40;
 
 // MIDI specific constants
+const int NUM_MIDI_NOTES = 128;
 const int MAX_VOLUME = 127;
 const int MAX_VELOCITY = 127;
 const int MAX_MODULATION = 127;
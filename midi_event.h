@@ -0,0 +1,19 @@
+/**
+ * Compact MIDI event passed between the instrument and the MIDI transmitter
+ */
+
+#ifndef MIDI_EVENT_H   /* Include guard */
+#define MIDI_EVENT_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+// A single MIDI channel message, packed into the three bytes it occupies on the wire
+struct MidiEvent {
+  uint8_t status; // MIDI message combined with the channel
+  uint8_t data1; // First data byte (note number, controller number, or pitch bend LSB)
+  uint8_t data2; // Second data byte (velocity, controller value, or pitch bend MSB)
+} __attribute__((packed));
+
+#endif // MIDI_EVENT_H
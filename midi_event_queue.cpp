@@ -0,0 +1,68 @@
+#include "midi_event_queue.h"
+
+/**
+ * Constructor to start with an empty queue
+ *
+ * @return void
+ */
+MidiEventQueue::MidiEventQueue() {
+  this->head = 0;
+  this->tail = 0;
+}
+
+/**
+ * Add a MIDI event to the queue
+ *
+ * @params uint8_t status The MIDI message combined with the channel
+ * @params uint8_t data1  The first data byte
+ * @params uint8_t data2  The second data byte
+ *
+ * @return bool Was the event queued (false if the queue was full)
+ */
+bool MidiEventQueue::push(uint8_t status, uint8_t data1, uint8_t data2) {
+  if((uint8_t)(this->head - this->tail) >= MIDI_EVENT_QUEUE_SIZE) {
+    return false;
+  }
+
+  MidiEvent * event = &this->events[this->head & (MIDI_EVENT_QUEUE_SIZE - 1)];
+  event->status = status;
+  event->data1 = data1;
+  event->data2 = data2;
+  this->head++;
+  return true;
+}
+
+/**
+ * Remove the oldest MIDI event from the queue
+ *
+ * @params MidiEvent * event The MIDI event to copy the oldest event into
+ *
+ * @return bool Was an event removed (false if the queue was empty)
+ */
+bool MidiEventQueue::pop(MidiEvent * event) {
+  if(this->isEmpty()) {
+    return false;
+  }
+
+  *event = this->events[this->tail & (MIDI_EVENT_QUEUE_SIZE - 1)];
+  this->tail++;
+  return true;
+}
+
+/**
+ * Is the queue empty
+ *
+ * @return bool
+ */
+bool MidiEventQueue::isEmpty() {
+  return this->head == this->tail;
+}
+
+/**
+ * Get the number of MIDI events which can be added before the queue is full
+ *
+ * @return uint8_t The number of free places in the queue
+ */
+uint8_t MidiEventQueue::getFreeCount() {
+  return MIDI_EVENT_QUEUE_SIZE - (uint8_t)(this->head - this->tail);
+}
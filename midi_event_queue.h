@@ -0,0 +1,34 @@
+/**
+ * Fixed capacity queue of MIDI events connecting the instrument to the MIDI transmitter
+ */
+
+#ifndef MIDI_EVENT_QUEUE_H   /* Include guard */
+#define MIDI_EVENT_QUEUE_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "midi_event.h"
+
+const uint8_t MIDI_EVENT_QUEUE_SIZE = 64; // Must be a power of two
+
+class MidiEventQueue {
+  public:
+    // Constructor: Start with an empty queue
+    MidiEventQueue();
+    // Add a MIDI event to the queue
+    bool push(uint8_t status, uint8_t data1, uint8_t data2);
+    // Remove the oldest MIDI event from the queue
+    bool pop(MidiEvent * event);
+    // Is the queue empty
+    bool isEmpty();
+    // Get the number of MIDI events which can be added before the queue is full
+    uint8_t getFreeCount();
+
+  private:
+    MidiEvent events[MIDI_EVENT_QUEUE_SIZE]; // Ring of queued MIDI events
+    uint8_t head; // Free running write index
+    uint8_t tail; // Free running read index
+};
+
+#endif // MIDI_EVENT_QUEUE_H
@@ -0,0 +1,40 @@
+#include "midi_transmitter.h"
+
+/**
+ * Constructor to start with no running status
+ *
+ * @return void
+ */
+MidiTransmitter::MidiTransmitter() {
+  this->runningStatus = 0;
+}
+
+/**
+ * Encode and send every queued MIDI event
+ *
+ * @params MidiEventQueue * queue The queue of MIDI events to send
+ *
+ * @return void
+ */
+void MidiTransmitter::transmit(MidiEventQueue * queue) {
+  MidiEvent event;
+  while(queue->pop(&event)) {
+    this->send(&event);
+  }
+}
+
+/**
+ * Encode and send a single MIDI event, omitting the status byte when it matches the running status
+ *
+ * @params MidiEvent * event The MIDI event to send
+ *
+ * @return void
+ */
+void MidiTransmitter::send(MidiEvent * event) {
+  if(!USE_RUNNING_STATUS || event->status != this->runningStatus) {
+    Serial.write(event->status);
+    this->runningStatus = event->status;
+  }
+  Serial.write(event->data1);
+  Serial.write(event->data2);
+}
@@ -0,0 +1,32 @@
+/**
+ * MIDI transmitter which encodes queued MIDI events and writes them to the serial port
+ */
+
+#ifndef MIDI_TRANSMITTER_H   /* Include guard */
+#define MIDI_TRANSMITTER_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "Arduino.h"
+#include "midi_event.h"
+#include "midi_event_queue.h"
+
+// Omit repeated status bytes. Off by default as not every serial to MIDI bridge supports running status
+const bool USE_RUNNING_STATUS = false;
+
+class MidiTransmitter {
+  public:
+    // Constructor: Start with no running status
+    MidiTransmitter();
+    // Encode and send every queued MIDI event
+    void transmit(MidiEventQueue * queue);
+
+  private:
+    uint8_t runningStatus; // Status byte of the last MIDI event sent (0 if none)
+
+    // Encode and send a single MIDI event
+    void send(MidiEvent * event);
+};
+
+#endif // MIDI_TRANSMITTER_H
@@ -1,25 +1,31 @@
 /**
  * Application entry point for the Spiral of Fifths instrument
  * 
- * Sets up the Arduino and instrument. Continuously reads and updates pin states. Calls the instruments play() method.
+ * Sets up the Arduino and instrument. Continuously reads and updates control pin states. Note keys are captured by
+ * interrupts onto the key event queue and scheduled events are timed by millis(). Calls the instruments
+ * play() method, then hands the MIDI events it queued to the MIDI transmitter.
  * 
  * Originally this was intended to perform all Arduino read/write communications and MIDI conversions. Unforunately
- * this required passing too much data around and exhausted the Arduino's memory causing SEGFAULTS. Instead I had to settle
- * for doing all Arudino write operations from the instrument class
+ * this required passing too much data around and exhausted the Arduino's memory causing SEGFAULTS. The stages are now
+ * connected by fixed capacity queues of three byte MIDI events instead, so nothing is allocated per message
  */
 
 #include "spiral_of_fiths.h"
 
 Pin pins[NUM_PINS_USED]; // All pins in use by the Arduino
 Instrument * instrument; // The instrument class performing all the logic
+KeyEventQueue keyEvents; // Note key transitions captured by interrupts
+KeyCapture keyCapture; // Interrupt driven capture of the note keys
+MidiEventQueue midiEvents; // MIDI events queued by the instrument for the transmitter
+MidiTransmitter transmitter; // Encodes and sends the queued MIDI events
 
 /**
- * Iterate through all arduino pins and set the values
+ * Iterate through all arduino control pins and set the values. Note keys are captured by interrupts instead
  *
- * @return voidm
+ * @return void
  */
 void setPinValues() {
-  for(int i = 0; i < NUM_PINS_USED; i++) {
+  for(int i = 0; i < FIRST_NOTE_PIN; i++) {
     if(pins[i].isDigital()) {
       pins[i].setValue(digitalRead(pins[i].getPinNumber()));
     } else {
@@ -29,12 +35,13 @@ void setPinValues() {
 }
 
 /**
- * Called upon program initialization. Instantiates the instrument, sets the baud rate, and initializes pins as inputs/outputs
+ * Called upon program initialization. Instantiates the instrument, sets the baud rate, initializes pins as inputs/outputs,
+ * and starts capturing the note keys
  *
  * @return void
  */
 void setup() {
-  instrument = new Instrument(pins);
+  instrument = new Instrument(pins, &midiEvents);
 
   //  Set MIDI baud rate:
   Serial.begin(57600, SERIAL_8N1);
@@ -43,15 +50,21 @@ void setup() {
   for(int i = 0; i < NUM_PINS; i++) {
      pinMode(i, INPUT);
   }
+
+  keyCapture.begin(pins, &keyEvents);
 }
 
 /**
- * Continuous program loop which sets the pin values and informs the instrument of the actions
+ * Continuous program loop which sets the pin values, informs the instrument of the actions, and sends the resulting MIDI events
  *
  * @return void
  */
 void loop() {
   setPinValues();
-  instrument->play(pins);
+  // The instrument stops early when the MIDI event queue cannot hold its next action, so drain it and carry on
+  while(!instrument->play(&keyEvents)) {
+    transmitter.transmit(&midiEvents);
+  }
+  transmitter.transmit(&midiEvents);
 }
 
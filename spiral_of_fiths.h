@@ -12,6 +12,12 @@
 #include <stdlib.h>
 #include "instrument.h"
 #include "pin.h"
+#include "key_event_queue.h"
+#include "key_capture.h"
+#include "timer_wheel.h"
+#include "midi_event_queue.h"
+#include "midi_transmitter.h"
+#include "active_notes.h"
 
 #endif // SPIRAL_OF_FITHS_H
 
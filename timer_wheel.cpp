@@ -0,0 +1,180 @@
+#include "timer_wheel.h"
+#include "Arduino.h"
+
+/**
+ * Constructor to start with every event on the free list and no events scheduled
+ *
+ * @return void
+ */
+TimerWheel::TimerWheel() {
+  for(uint8_t i = 0; i < TIMER_WHEEL_CAPACITY; i++) {
+    this->next[i] = i + 1 < TIMER_WHEEL_CAPACITY ? i + 1 : TIMER_WHEEL_NONE;
+  }
+  for(uint8_t i = 0; i < TIMER_WHEEL_SLOTS; i++) {
+    this->slots[i] = TIMER_WHEEL_NONE;
+  }
+  this->freeHead = 0;
+  this->expiredHead = TIMER_WHEEL_NONE;
+  this->expiredTail = TIMER_WHEEL_NONE;
+  this->currentTick = 0;
+}
+
+/**
+ * Get the current tick of the clock driving the wheel. The core already counts milliseconds from its Timer0
+ * interrupt, so no other hardware timer is taken for the wheel
+ *
+ * @return unsigned long The number of milliseconds since the program started
+ */
+unsigned long TimerWheel::getTick() {
+  return millis();
+}
+
+/**
+ * Schedule an event for the given tick. Events scheduled for a tick which has already passed expire immediately
+ *
+ * @params unsigned long tick The tick to fire the event at
+ * @params uint8_t       type The type of the event
+ * @params uint8_t       data Event specific data
+ *
+ * @return uint8_t Handle of the scheduled event (TIMER_WHEEL_NONE if the wheel is full)
+ */
+uint8_t TimerWheel::schedule(unsigned long tick, uint8_t type, uint8_t data) {
+  uint8_t index = this->freeHead;
+  if(index == TIMER_WHEEL_NONE) {
+    return TIMER_WHEEL_NONE;
+  }
+  this->freeHead = this->next[index];
+
+  this->events[index].type = type;
+  this->events[index].data = data;
+  this->events[index].tick = tick;
+  if((long)(tick - this->currentTick) <= 0) {
+    this->expire(index);
+  } else {
+    uint8_t slot = tick & (TIMER_WHEEL_SLOTS - 1);
+    this->next[index] = this->slots[slot];
+    this->slots[slot] = index;
+  }
+  return index;
+}
+
+/**
+ * Schedule the next occurrence of a periodic event one interval after its previous tick. When the loop has run late
+ * the tick is advanced in whole intervals past the current tick, so missed periods are skipped rather than replayed
+ * as a burst while the event keeps its original phase
+ *
+ * @params unsigned long tick     The tick the previous occurrence was scheduled for
+ * @params unsigned long interval The number of ticks between occurrences
+ * @params uint8_t       type     The type of the event
+ * @params uint8_t       data     Event specific data
+ *
+ * @return uint8_t Handle of the scheduled event (TIMER_WHEEL_NONE if the wheel is full)
+ */
+uint8_t TimerWheel::schedulePeriodic(unsigned long tick, unsigned long interval, uint8_t type, uint8_t data) {
+  tick += interval;
+  if((long)(tick - this->currentTick) <= 0) {
+    tick += ((this->currentTick - tick) / interval + 1) * interval;
+  }
+  return this->schedule(tick, type, data);
+}
+
+/**
+ * Cancel a scheduled event. The event stays in its slot until it expires and is then released without being popped
+ *
+ * @params uint8_t handle The handle returned when the event was scheduled
+ *
+ * @return void
+ */
+void TimerWheel::cancel(uint8_t handle) {
+  if(handle < TIMER_WHEEL_CAPACITY) {
+    this->events[handle].type = TIMER_EVENT_CANCELLED;
+  }
+}
+
+/**
+ * Cancel all scheduled events
+ *
+ * @return void
+ */
+void TimerWheel::cancelAll() {
+  for(uint8_t i = 0; i < TIMER_WHEEL_CAPACITY; i++) {
+    this->events[i].type = TIMER_EVENT_CANCELLED;
+  }
+}
+
+/**
+ * Expire all events scheduled up to and including the given tick. Each slot holds events for every tick that maps
+ * onto it, so only the events whose tick matches are expired
+ *
+ * @params unsigned long tick The tick to advance the wheel to
+ *
+ * @return void
+ */
+void TimerWheel::advance(unsigned long tick) {
+  while((long)(tick - this->currentTick) > 0) {
+    this->currentTick++;
+    uint8_t * link = &this->slots[this->currentTick & (TIMER_WHEEL_SLOTS - 1)];
+    while(*link != TIMER_WHEEL_NONE) {
+      uint8_t index = *link;
+      if(this->events[index].tick == this->currentTick) {
+        *link = this->next[index];
+        this->expire(index);
+      } else {
+        link = &this->next[index];
+      }
+    }
+  }
+}
+
+/**
+ * Remove the oldest expired event, releasing any cancelled events along the way
+ *
+ * @params TimerEvent * event The timer event to copy the expired event into
+ *
+ * @return bool Was an event removed (false if no events have expired)
+ */
+bool TimerWheel::pop(TimerEvent * event) {
+  while(this->expiredHead != TIMER_WHEEL_NONE) {
+    uint8_t index = this->expiredHead;
+    this->expiredHead = this->next[index];
+    if(this->expiredHead == TIMER_WHEEL_NONE) {
+      this->expiredTail = TIMER_WHEEL_NONE;
+    }
+
+    *event = this->events[index];
+    this->release(index);
+    if(event->type != TIMER_EVENT_CANCELLED) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Append an event to the expired list
+ *
+ * @params uint8_t index The index of the event in the pool
+ *
+ * @return void
+ */
+void TimerWheel::expire(uint8_t index) {
+  this->next[index] = TIMER_WHEEL_NONE;
+  if(this->expiredTail == TIMER_WHEEL_NONE) {
+    this->expiredHead = index;
+  } else {
+    this->next[this->expiredTail] = index;
+  }
+  this->expiredTail = index;
+}
+
+/**
+ * Return an event to the free list
+ *
+ * @params uint8_t index The index of the event in the pool
+ *
+ * @return void
+ */
+void TimerWheel::release(uint8_t index) {
+  this->next[index] = this->freeHead;
+  this->freeHead = index;
+}
@@ -0,0 +1,59 @@
+/**
+ * Fixed capacity timer wheel for scheduling instrument events. Events are scheduled at an absolute millis() tick
+ * (counted by the core's Timer0 interrupt), inserted and expired in constant time, and never allocate memory
+ */
+
+#ifndef TIMER_WHEEL_H   /* Include guard */
+#define TIMER_WHEEL_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+const uint8_t TIMER_WHEEL_SLOTS = 32; // Must be a power of two
+const uint8_t TIMER_WHEEL_CAPACITY = 40; // Enough for a repeating event on every note key plus the arpeggiator
+const uint8_t TIMER_WHEEL_NONE = 0xFF; // Handle returned when an event could not be scheduled
+const uint8_t TIMER_EVENT_CANCELLED = 0xFF; // Event type of an event which has been cancelled
+
+// A scheduled event
+struct TimerEvent {
+  uint8_t type; // What the event does, defined by the scheduling class
+  uint8_t data; // Event specific data
+  unsigned long tick; // The tick the event was scheduled for
+};
+
+class TimerWheel {
+  public:
+    // Constructor: Start with every event free and no events scheduled
+    TimerWheel();
+    // Get the current tick of the clock driving the wheel
+    static unsigned long getTick();
+    // Schedule an event for the given tick, returning a handle which can be used to cancel it
+    uint8_t schedule(unsigned long tick, uint8_t type, uint8_t data);
+    // Schedule the next occurrence of a periodic event, skipping any periods which have already passed
+    uint8_t schedulePeriodic(unsigned long tick, unsigned long interval, uint8_t type, uint8_t data);
+    // Cancel a scheduled event which has not been popped yet
+    void cancel(uint8_t handle);
+    // Cancel all scheduled events
+    void cancelAll();
+    // Expire all events scheduled up to and including the given tick
+    void advance(unsigned long tick);
+    // Remove the oldest expired event
+    bool pop(TimerEvent * event);
+
+  private:
+    TimerEvent events[TIMER_WHEEL_CAPACITY]; // Pool of events
+    uint8_t next[TIMER_WHEEL_CAPACITY]; // Next event in the same slot, expired list, or free list
+    uint8_t slots[TIMER_WHEEL_SLOTS]; // First event scheduled in each slot
+    uint8_t freeHead; // First unused event
+    uint8_t expiredHead; // Oldest expired event
+    uint8_t expiredTail; // Newest expired event
+    unsigned long currentTick; // The last tick the wheel was advanced to
+
+    // Append an event to the expired list
+    void expire(uint8_t index);
+    // Return an event to the free list
+    void release(uint8_t index);
+};
+
+#endif // TIMER_WHEEL_H